@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <array>
@@ -46,4 +47,64 @@ struct DirectoryEntry {
     void serialize(uint8_t raw[32]) const;
 };
 
+// Visão sem cópia de uma entrada de 32 bytes; lê os campos direto do buffer do diretório
+class DirectoryEntryView {
+public:
+    explicit DirectoryEntryView(const uint8_t* raw) : raw_(raw) {}
+
+    const uint8_t* data() const { return raw_; }
+    const uint8_t* name() const { return raw_; } // 11 bytes 8.3
+    uint8_t attr() const { return raw_[0x0B]; }
+    uint16_t wrtTime() const { return le16(raw_ + 0x16); }
+    uint16_t wrtDate() const { return le16(raw_ + 0x18); }
+    uint16_t firstCluster() const { return le16(raw_ + 0x1A); }
+    uint32_t fileSize() const { return le32(raw_ + 0x1C); }
+
+    bool isLFN() const { return (attr() & 0x0F) == ATTR_LFN; }
+    bool isVolume() const { return (attr() & ATTR_VOLUME_ID) != 0; }
+    bool isDirectory() const { return (attr() & ATTR_DIRECTORY) != 0; }
+    bool isDeleted() const { return raw_[0] == 0xE5; }
+    bool isUnused() const { return raw_[0] == 0x00; }
+    bool isFile() const { return !isLFN() && !isVolume() && !isDirectory() && !isDeleted() && !isUnused(); }
+
+    // Escreve "NAME.EXT" em out (sem alocar) e retorna o comprimento
+    size_t displayName(char out[13]) const { return format_display_name(raw_, out); }
+
+    DirectoryEntry entry() const { return DirectoryEntry::parse(raw_); }
+
+private:
+    const uint8_t* raw_;
+};
+
+// Sequência de entradas de um diretório bruto, terminada na primeira entrada 0x00
+class DirectoryView {
+public:
+    class iterator {
+    public:
+        explicit iterator(const uint8_t* p) : p_(p) {}
+        DirectoryEntryView operator*() const { return DirectoryEntryView(p_); }
+        iterator& operator++() { p_ += 32; return *this; }
+        bool operator!=(const iterator& o) const { return p_ != o.p_; }
+        bool operator==(const iterator& o) const { return p_ == o.p_; }
+    private:
+        const uint8_t* p_;
+    };
+
+    DirectoryView(const uint8_t* raw, size_t bytes) : raw_(raw), slots_(bytes / 32), used_(0) {
+        while (used_ < slots_ && raw_[used_ * 32] != 0x00) ++used_;
+    }
+
+    const uint8_t* data() const { return raw_; }
+    size_t size() const { return used_; } // entradas antes do marcador de fim
+    size_t capacity() const { return slots_; }
+    DirectoryEntryView operator[](size_t i) const { return DirectoryEntryView(raw_ + i * 32); }
+    iterator begin() const { return iterator(raw_); }
+    iterator end() const { return iterator(raw_ + used_ * 32); }
+
+private:
+    const uint8_t* raw_;
+    size_t slots_;
+    size_t used_;
+};
+
 } // namespace fat16
@@ -1,11 +1,16 @@
 #pragma once
 #include <array>
 #include <cstdint>
-#include <fstream>
+#include <functional>
+#include <ios>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
 #include "directory_entry.hpp"
+#include "fat_scan.hpp"
+#include "rw_lock.hpp"
 
 namespace fat16 {
 
@@ -34,14 +39,66 @@ struct FileAttributes {
     std::string name;
 };
 
+// Arquivo a importar em lote: size bytes lidos de hostPath a partir de offset
+struct ImportItem {
+    std::string targetName; // convertido para 8.3
+    std::string hostPath;
+    uint64_t offset{};      // início dos dados em hostPath (ex.: dentro de um tar)
+    uint32_t size{};
+    std::time_t mtime{};    // 0 = hora atual
+};
+
+// Resultado da devolução de clusters livres ao armazenamento do host
+struct HoleStats {
+    size_t ranges{};  // intervalos passados ao fallocate (clusters adjacentes já unidos)
+    uint64_t bytes{}; // bytes que estavam alocados no host; trechos que já eram buracos não contam
+};
+
+// Thread-safety: leituras (list, cat, attrs, read_fat, ...) podem ser feitas por
+// várias threads ao mesmo tempo; escritas são serializadas por um RwLock,
+// que dá prioridade a escritores para que leituras contínuas não os bloqueiem.
+// O acesso ao disco usa pread/pwrite, sem posição de arquivo compartilhada.
 class FAT16Image {
 public:
     FAT16Image(const std::string& path, bool readWrite);
+    ~FAT16Image();
+    FAT16Image(const FAT16Image&) = delete;
+    FAT16Image& operator=(const FAT16Image&) = delete;
+
+    // Leitura sequencial dos dados de um arquivo a partir de uma cópia da sua
+    // cadeia de clusters; clusters contíguos no disco são lidos com um único pread.
+    // Válido apenas dentro de visit_root_files.
+    class FileReader {
+    public:
+        // Lê até cap bytes em dst; retorna 0 no fim do arquivo
+        size_t read(uint8_t* dst, size_t cap);
+        uint32_t remaining() const { return remaining_; }
+
+    private:
+        friend class FAT16Image;
+        // lockPerRead: cada read() trava a imagem para leitura só durante o pread
+        FileReader(const FAT16Image& img, std::vector<uint16_t> chain, uint32_t size, bool lockPerRead)
+            : img_(img), chain_(std::move(chain)), remaining_(size), lockPerRead_(lockPerRead) {}
+
+        const FAT16Image& img_;
+        std::vector<uint16_t> chain_; // clusters do arquivo, copiados da FAT
+        size_t index_{};              // posição atual em chain_
+        uint32_t offsetInCluster_{};
+        uint32_t remaining_;
+        bool lockPerRead_;
+    };
 
     // Info
     const BPB& bpb() const { return bpb_; }
 
     // Diretório raiz
+    // Chama f(DirectoryView) com o diretório travado para leitura; a visão não deve
+    // escapar de f, pois aponta para a cópia em memória
+    template <class F>
+    auto with_root_dir(F&& f) const {
+        std::shared_lock<RwLock> lock(mu_);
+        return f(root_dir_());
+    }
     std::vector<std::pair<std::string, uint32_t>> list_root_files();
     DirectoryEntry get_entry_by_name(const std::string& name);
     int find_entry_index_by_name11(const std::array<char,11>& name11);
@@ -49,36 +106,71 @@ public:
 
     // Arquivos
     std::vector<uint8_t> read_file_by_name(const std::string& name);
+    // Chama fn(entrada, leitor) para cada arquivo do diretório raiz. Entradas e
+    // cadeias são copiadas com a imagem travada; depois a trava só é retomada a cada
+    // read() do leitor, então escritas não esperam fn. Um arquivo alterado durante a
+    // visita pode ser lido com trechos de antes e de depois da alteração.
+    void visit_root_files(const std::function<void(const DirectoryEntry&, FileReader&)>& fn) const;
     FileAttributes get_attributes(const std::string& name);
     void rename_file(const std::string& oldName, const std::string& newName);
-    void remove_file(const std::string& name);
+    // punchHoles: também devolve ao host os clusters liberados (FALLOC_FL_PUNCH_HOLE)
+    HoleStats remove_file(const std::string& name, bool punchHoles = false);
     void add_file(const std::string& hostPath, const std::string& targetName);
+    // Importa vários arquivos de uma vez: valida nomes, entradas livres e espaço
+    // antes de escrever, dá a cada arquivo uma extensão contígua quando possível,
+    // grava os dados numa varredura sequencial e atualiza FAT e diretório uma vez.
+    // Lança std::runtime_error sem alterar a imagem se o lote não couber.
+    size_t import_files(const std::vector<ImportItem>& items);
 
     // FAT
     uint16_t read_fat(uint16_t cluster);
     void write_fat(uint16_t cluster, uint16_t value);
     std::vector<uint16_t> allocate_chain(size_t count);
     void free_chain(uint16_t firstCluster);
+    FreeSpaceStats free_space_stats() const;
+    // Libera no arquivo de imagem todas as sequências de clusters livres da FAT
+    HoleStats trim();
 
     // Dados
     std::vector<uint8_t> read_file_data(uint16_t firstCluster, uint32_t size);
     void write_file_data(const std::vector<uint8_t>& data, const std::vector<uint16_t>& chain);
 
 private:
+    // Versões sem trava; o chamador deve manter mu_ (compartilhado ou exclusivo)
+    DirectoryView root_dir_() const { return DirectoryView(rootDir_.data(), rootDir_.size()); }
+    DirectoryEntry get_entry_(const std::string& name) const;
+    int find_entry_index_(const std::array<char,11>& name11) const;
+    int find_free_dir_index_() const;
+    uint16_t read_fat_(uint16_t cluster) const;
+    // Clusters que guardam os size bytes do arquivo; termina antes se a cadeia acabar
+    std::vector<uint16_t> chain_of_(uint16_t firstCluster, uint32_t size) const;
+    void write_fat_(uint16_t cluster, uint16_t value);
+    std::vector<uint16_t> allocate_chain_(size_t count);
+    void free_chain_(uint16_t firstCluster, std::vector<uint16_t>* freed = nullptr);
+    HoleStats punch_runs_(const std::vector<FreeRun>& runs);
+    uint64_t data_bytes_(std::streamoff off, size_t len) const;
+    bool is_hole_(std::streamoff off, size_t len) const;
+    std::vector<uint8_t> read_file_data_(uint16_t firstCluster, uint32_t size) const;
+    void write_file_data_(const std::vector<uint8_t>& data, const std::vector<uint16_t>& chain);
+
     void load_bpb_();
+    void load_fat_();
     uint32_t sector_of_cluster_(uint16_t clus) const;
     std::streamoff offset_of_sector_(uint32_t sector) const;
     std::streamoff offset_of_cluster_(uint16_t clus) const;
     uint32_t root_dir_offset_() const;
     size_t root_dir_bytes_() const;
-    std::vector<DirectoryEntry> read_root_dir(std::vector<uint8_t>* rawOut);
-    uint16_t find_free_cluster(uint16_t startFrom);
+    void load_root_dir_();
+    uint16_t find_free_cluster(uint16_t startFrom) const;
     void write_root_entry(size_t index, const DirectoryEntry& e);
+    void flush_fat_range_(size_t first, size_t last);
+    void flush_root_range_(size_t first, size_t last);
 
     // estado
     std::string imagePath_;
     bool rw_{};
-    std::fstream fs_;
+    int fd_{-1};
+    mutable RwLock mu_; // protege fat_, rootDir_ e a área de dados
     BPB bpb_{};
     uint32_t totalSectors_{};
     uint32_t rootDirSectors_{};
@@ -87,6 +179,8 @@ private:
     uint32_t firstDataSector_{};
     uint32_t bytesPerCluster_{};
     uint32_t totalClusters_{};
+    std::vector<uint16_t> fat_; // cópia em memória da primeira FAT
+    std::vector<uint8_t> rootDir_; // cópia em memória do diretório raiz (bytes brutos)
 };
 
 } // namespace fat16
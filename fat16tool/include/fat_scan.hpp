@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fat16 {
+
+// Valores especiais de entrada da FAT16
+constexpr uint16_t FAT_FREE = 0x0000;
+constexpr uint16_t FAT_BAD  = 0xFFF7;
+
+// Estatísticas de espaço livre obtidas varrendo a FAT em memória.
+// runHistogram[i] conta sequências livres com tamanho em [2^i, 2^(i+1)) clusters.
+struct FreeSpaceStats {
+    uint32_t totalClusters{};
+    uint32_t freeClusters{};
+    uint32_t badClusters{};
+    uint32_t usedClusters{};
+    uint32_t largestFreeRun{}; // em clusters
+    uint32_t freeRuns{};
+    uint32_t bytesPerCluster{};
+    std::array<uint32_t, 17> runHistogram{};
+    uint64_t scanMicros{}; // tempo da varredura
+};
+
+// Sequência de clusters livres consecutivos
+struct FreeRun {
+    uint32_t start{};
+    uint32_t length{};
+};
+
+namespace scan {
+
+// Nome do kernel selecionado em compilação ("avx2", "sse2" ou "scalar")
+const char* kernel_name();
+
+// Primeiro índice em [begin, end) com fat[i] == FAT_FREE, ou end se não houver
+size_t find_free(const uint16_t* fat, size_t begin, size_t end);
+
+// Varre fat[begin, end) e preenche contadores, maior sequência e histograma
+// (bytesPerCluster e scanMicros ficam a cargo do chamador)
+FreeSpaceStats free_space(const uint16_t* fat, size_t begin, size_t end);
+
+// Todas as sequências livres de fat[begin, end), em ordem crescente de cluster
+std::vector<FreeRun> free_runs(const uint16_t* fat, size_t begin, size_t end);
+
+// Primeiro slot em [begin, end) de um diretório bruto (32 bytes por entrada)
+// cujo nome 8.3 é igual a name11, ou end se não houver
+size_t find_name11(const uint8_t* dir, size_t begin, size_t end, const uint8_t name11[11]);
+
+} // namespace scan
+} // namespace fat16
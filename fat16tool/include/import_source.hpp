@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "fat16_image.hpp"
+
+namespace fat16 {
+
+// Lista os arquivos a importar de um diretório do host (arquivos regulares,
+// sem recursão) ou de um tar POSIX (entradas regulares, mtime preservado),
+// já com o tamanho de cada um. Não lê os dados.
+std::vector<ImportItem> scan_import_source(const std::string& path);
+
+} // namespace fat16
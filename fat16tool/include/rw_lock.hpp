@@ -0,0 +1,55 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+
+namespace fat16 {
+
+// Trava leitor-escritor que dá preferência a escritores: assim que um escritor
+// espera, novos leitores aguardam, então leituras contínuas não o bloqueiam para
+// sempre (o std::shared_mutex da glibc prefere leitores). Compatível com
+// std::shared_lock e std::unique_lock.
+class RwLock {
+public:
+    void lock() {
+        std::unique_lock<std::mutex> lk(mu_);
+        ++writersWaiting_;
+        writerCv_.wait(lk, [this] { return !writerActive_ && readers_ == 0; });
+        --writersWaiting_;
+        writerActive_ = true;
+    }
+
+    void unlock() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            writerActive_ = false;
+        }
+        // outro escritor na fila tem prioridade; os leitores reavaliam a condição
+        writerCv_.notify_one();
+        readerCv_.notify_all();
+    }
+
+    void lock_shared() {
+        std::unique_lock<std::mutex> lk(mu_);
+        readerCv_.wait(lk, [this] { return !writerActive_ && writersWaiting_ == 0; });
+        ++readers_;
+    }
+
+    void unlock_shared() {
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            last = (--readers_ == 0);
+        }
+        if (last) writerCv_.notify_one();
+    }
+
+private:
+    std::mutex mu_;
+    std::condition_variable readerCv_;
+    std::condition_variable writerCv_;
+    unsigned readers_{};
+    unsigned writersWaiting_{};
+    bool writerActive_{};
+};
+
+} // namespace fat16
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include "fat16_image.hpp"
+
+namespace fat16 {
+
+struct TarExportOptions {
+    size_t bufferCount = 8;           // buffers no anel
+    size_t bufferSize = 64 * 1024;    // bytes por buffer (múltiplo de 512)
+};
+
+// Escreve todos os arquivos do diretório raiz em out como um tar POSIX (ustar).
+// A leitura das cadeias roda na thread chamadora e a escrita em out numa thread
+// separada; as duas trocam dados por um anel fixo de buffers reutilizados, então
+// a memória usada não depende do tamanho dos arquivos.
+// Retorna a quantidade de arquivos exportados; lança std::runtime_error em falha.
+size_t export_tar(const FAT16Image& img, std::FILE* out, const TarExportOptions& opts = {});
+
+} // namespace fat16
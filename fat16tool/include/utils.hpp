@@ -48,6 +48,10 @@ std::array<char, 11> make_83_name(const std::string& input);
 // Converte 11 bytes para string "NAME.EXT" (sem espaços)
 std::string to_display_name(const uint8_t name11[11]);
 
+// Mesmo formato de to_display_name, escrito em out (mín. 13 bytes, terminado em '\0')
+// sem alocação; retorna o comprimento
+size_t format_display_name(const uint8_t name11[11], char out[13]);
+
 // Utilitário: reparte bytes de um buffer em blocos de tamanho fixo
 std::vector<std::vector<uint8_t>> chunk(const std::vector<uint8_t>& data, size_t chunkSize);
 
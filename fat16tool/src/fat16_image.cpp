@@ -1,23 +1,100 @@
 #include "fat16_image.hpp"
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <fstream>
 #include <stdexcept>
 #include <vector>
 #include <iomanip>
+#include <fcntl.h>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE) && defined(SEEK_DATA)
+#include <sys/stat.h>
+#define FAT16_HAVE_PUNCH_HOLE 1
+#endif
 
 namespace fat16 {
 
-static void read_exact(std::fstream& fs, std::streamoff off, void* buf, std::size_t n) {
-    fs.seekg(off);
-    fs.read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(n));
-    if (!fs) throw std::runtime_error("Falha ao ler da imagem");
+// E/S posicional: não há posição de arquivo compartilhada, então leituras
+// concorrentes não precisam de trava
+#ifdef _WIN32
+static long long pread_(int fd, void* buf, std::size_t n, std::streamoff off) {
+    OVERLAPPED ov{};
+    ov.Offset = static_cast<DWORD>(off & 0xFFFFFFFF);
+    ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(off) >> 32);
+    DWORD got = 0;
+    if (!ReadFile(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), buf, static_cast<DWORD>(n), &got, &ov)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    }
+    return got;
+}
+
+static long long pwrite_(int fd, const void* buf, std::size_t n, std::streamoff off) {
+    OVERLAPPED ov{};
+    ov.Offset = static_cast<DWORD>(off & 0xFFFFFFFF);
+    ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(off) >> 32);
+    DWORD put = 0;
+    if (!WriteFile(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), buf, static_cast<DWORD>(n), &put, &ov)) return -1;
+    return put;
+}
+#else
+static long long pread_(int fd, void* buf, std::size_t n, std::streamoff off) {
+    return ::pread(fd, buf, n, static_cast<off_t>(off));
 }
 
-static void write_exact(std::fstream& fs, std::streamoff off, const void* buf, std::size_t n) {
-    fs.seekp(off);
-    fs.write(reinterpret_cast<const char*>(buf), static_cast<std::streamsize>(n));
-    if (!fs) throw std::runtime_error("Falha ao escrever na imagem");
-    fs.flush();
+static long long pwrite_(int fd, const void* buf, std::size_t n, std::streamoff off) {
+    return ::pwrite(fd, buf, n, static_cast<off_t>(off));
+}
+#endif
+
+// Só o caminho POSIX sinaliza interrupção por errno; ReadFile/WriteFile não o usam
+static bool interrupted(long long r) {
+#ifdef _WIN32
+    (void)r;
+    return false;
+#else
+    return r < 0 && errno == EINTR;
+#endif
+}
+
+static void close_fd(int fd) {
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+static void read_exact(int fd, std::streamoff off, void* buf, std::size_t n) {
+    auto p = static_cast<uint8_t*>(buf);
+    while (n > 0) {
+        long long r = pread_(fd, p, n, off);
+        if (interrupted(r)) continue;
+        if (r <= 0) throw std::runtime_error("Falha ao ler da imagem");
+        p += r;
+        n -= static_cast<std::size_t>(r);
+        off += r;
+    }
+}
+
+static void write_exact(int fd, std::streamoff off, const void* buf, std::size_t n) {
+    auto p = static_cast<const uint8_t*>(buf);
+    while (n > 0) {
+        long long r = pwrite_(fd, p, n, off);
+        if (interrupted(r)) continue;
+        if (r <= 0) throw std::runtime_error("Falha ao escrever na imagem");
+        p += r;
+        n -= static_cast<std::size_t>(r);
+        off += r;
+    }
 }
 
 DirectoryEntry DirectoryEntry::parse(const uint8_t raw[32]) {
@@ -55,16 +132,31 @@ void DirectoryEntry::serialize(uint8_t raw[32]) const {
 
 FAT16Image::FAT16Image(const std::string& path, bool readWrite)
     : imagePath_(path), rw_(readWrite) {
-    std::ios::openmode mode = std::ios::binary | std::ios::in;
-    if (rw_) mode |= std::ios::out;
-    fs_.open(imagePath_, mode);
-    if (!fs_) throw std::runtime_error("Não foi possível abrir a imagem: " + path);
-    load_bpb_();
+#ifdef _WIN32
+    int flags = (rw_ ? _O_RDWR : _O_RDONLY) | _O_BINARY;
+    fd_ = ::_open(imagePath_.c_str(), flags);
+#else
+    int flags = (rw_ ? O_RDWR : O_RDONLY) | O_CLOEXEC;
+    fd_ = ::open(imagePath_.c_str(), flags);
+#endif
+    if (fd_ < 0) throw std::runtime_error("Não foi possível abrir a imagem: " + path);
+    try {
+        load_bpb_();
+        load_fat_();
+        load_root_dir_();
+    } catch (...) {
+        close_fd(fd_);
+        throw;
+    }
+}
+
+FAT16Image::~FAT16Image() {
+    if (fd_ >= 0) close_fd(fd_);
 }
 
 void FAT16Image::load_bpb_() {
     std::array<uint8_t, 512> boot{};
-    read_exact(fs_, 0, boot.data(), boot.size());
+    read_exact(fd_, 0, boot.data(), boot.size());
 
     bpb_.bytesPerSector = le16(boot.data() + 0x0B);
     bpb_.sectorsPerCluster = boot[0x0D];
@@ -95,6 +187,17 @@ void FAT16Image::load_bpb_() {
     }
 }
 
+void FAT16Image::load_fat_() {
+    // Mantém a primeira FAT inteira em memória; as cópias em disco são atualizadas em write_fat
+    size_t fatBytes = static_cast<size_t>(bpb_.fatSize16) * bpb_.bytesPerSector;
+    std::vector<uint8_t> raw(fatBytes);
+    read_exact(fd_, offset_of_sector_(firstFATSector_), raw.data(), raw.size());
+
+    size_t entries = std::min<size_t>(fatBytes / 2, static_cast<size_t>(totalClusters_) + 2);
+    fat_.resize(entries);
+    for (size_t i = 0; i < entries; ++i) fat_[i] = le16(raw.data() + i * 2);
+}
+
 uint32_t FAT16Image::sector_of_cluster_(uint16_t clus) const {
     if (clus < 2) throw std::runtime_error("Cluster inválido (<2)");
     return firstDataSector_ + static_cast<uint32_t>(clus - 2) * bpb_.sectorsPerCluster;
@@ -108,34 +211,43 @@ std::streamoff FAT16Image::offset_of_cluster_(uint16_t clus) const {
     return offset_of_sector_(sector_of_cluster_(clus));
 }
 
-uint16_t FAT16Image::read_fat(uint16_t cluster) {
-    std::array<uint8_t, 2> buf{};
-    auto off = offset_of_sector_(firstFATSector_) + static_cast<std::streamoff>(cluster) * 2;
-    read_exact(fs_, off, buf.data(), buf.size());
-    return static_cast<uint16_t>(buf[0]) | (static_cast<uint16_t>(buf[1]) << 8);
+uint16_t FAT16Image::read_fat_(uint16_t cluster) const {
+    if (cluster >= fat_.size()) throw std::runtime_error("Cluster fora da FAT");
+    return fat_[cluster];
 }
 
-void FAT16Image::write_fat(uint16_t cluster, uint16_t value) {
+void FAT16Image::write_fat_(uint16_t cluster, uint16_t value) {
     if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
+    if (cluster >= fat_.size()) throw std::runtime_error("Cluster fora da FAT");
     std::array<uint8_t, 2> buf{ static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>((value >> 8) & 0xFF) };
     for (int i = 0; i < bpb_.numFATs; ++i) {
         auto fatSector = firstFATSector_ + static_cast<uint32_t>(i) * bpb_.fatSize16;
         auto off = offset_of_sector_(fatSector) + static_cast<std::streamoff>(cluster) * 2;
-        write_exact(fs_, off, buf.data(), buf.size());
+        write_exact(fd_, off, buf.data(), buf.size());
     }
+    fat_[cluster] = value;
 }
 
-uint16_t FAT16Image::find_free_cluster(uint16_t startFrom) {
+uint16_t FAT16Image::find_free_cluster(uint16_t startFrom) const {
     if (startFrom < 2) startFrom = 2;
-    for (uint32_t c = startFrom; c < totalClusters_ + 2; ++c) {
-        if (read_fat(static_cast<uint16_t>(c)) == 0x0000) {
-            return static_cast<uint16_t>(c);
-        }
-    }
-    return 0; // nenhum livre
+    size_t end = fat_.size();
+    if (startFrom >= end) return 0;
+    size_t c = scan::find_free(fat_.data(), startFrom, end);
+    return c < end ? static_cast<uint16_t>(c) : 0; // 0 = nenhum livre
 }
 
-std::vector<uint16_t> FAT16Image::allocate_chain(size_t count) {
+FreeSpaceStats FAT16Image::free_space_stats() const {
+    std::shared_lock<RwLock> lock(mu_);
+    auto t0 = std::chrono::steady_clock::now();
+    FreeSpaceStats st = scan::free_space(fat_.data(), 2, fat_.size());
+    auto t1 = std::chrono::steady_clock::now();
+    st.bytesPerCluster = bytesPerCluster_;
+    st.scanMicros = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+    return st;
+}
+
+std::vector<uint16_t> FAT16Image::allocate_chain_(size_t count) {
     if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
     std::vector<uint16_t> chain;
     chain.reserve(count);
@@ -144,53 +256,96 @@ std::vector<uint16_t> FAT16Image::allocate_chain(size_t count) {
         uint16_t free = find_free_cluster(prev ? prev + 1 : 2);
         if (free == 0) {
             // rollback
-            for (auto c : chain) write_fat(c, 0x0000);
+            for (auto c : chain) write_fat_(c, 0x0000);
             throw std::runtime_error("Sem espaço livre para alocar clusters");
         }
-        write_fat(free, 0xFFF8); // marca provisoriamente como EOC
-        if (prev != 0) write_fat(prev, free);
+        write_fat_(free, 0xFFF8); // marca provisoriamente como EOC
+        if (prev != 0) write_fat_(prev, free);
         chain.push_back(free);
         prev = free;
     }
     // marca último como EOC
-    if (!chain.empty()) write_fat(chain.back(), 0xFFFF);
+    if (!chain.empty()) write_fat_(chain.back(), 0xFFFF);
     return chain;
 }
 
-std::vector<uint8_t> FAT16Image::read_file_data(uint16_t firstCluster, uint32_t size) {
+std::vector<uint16_t> FAT16Image::chain_of_(uint16_t firstCluster, uint32_t size) const {
+    std::vector<uint16_t> chain;
+    if (size == 0) return chain;
+    size_t count = (size_t{size} + bytesPerCluster_ - 1) / bytesPerCluster_;
+    chain.reserve(count);
+    uint16_t c = firstCluster;
+    // cadeia menor que o tamanho declarado: o leitor entrega o que houver
+    while (chain.size() < count && c >= 0x0002 && c < 0xFFF8) {
+        chain.push_back(c);
+        c = read_fat_(c);
+    }
+    return chain;
+}
+
+size_t FAT16Image::FileReader::read(uint8_t* dst, size_t cap) {
+    std::shared_lock<RwLock> lock(img_.mu_, std::defer_lock);
+    if (lockPerRead_) lock.lock();
+
+    const uint32_t bpc = img_.bytesPerCluster_;
+    size_t done = 0;
+    while (done < cap && remaining_ > 0) {
+        if (index_ >= chain_.size()) {
+            remaining_ = 0;
+            break;
+        }
+        size_t want = std::min<size_t>(cap - done, remaining_);
+
+        // estende a leitura enquanto o próximo cluster da cadeia é o seguinte no disco
+        size_t last = index_;
+        size_t span = bpc - offsetInCluster_;
+        while (span < want && last + 1 < chain_.size() &&
+               chain_[last + 1] == static_cast<uint16_t>(chain_[last] + 1)) {
+            ++last;
+            span += bpc;
+        }
+        size_t n = std::min(span, want);
+        read_exact(img_.fd_, img_.offset_of_cluster_(chain_[index_]) + offsetInCluster_, dst + done, n);
+        done += n;
+        remaining_ -= static_cast<uint32_t>(n);
+
+        // avança a posição na cadeia
+        size_t pos = offsetInCluster_ + n;
+        index_ += pos / bpc;
+        offsetInCluster_ = static_cast<uint32_t>(pos % bpc);
+    }
+    return done;
+}
+
+std::vector<uint8_t> FAT16Image::read_file_data_(uint16_t firstCluster, uint32_t size) const {
     std::vector<uint8_t> out;
     if (size == 0 || firstCluster == 0) return out;
-    out.reserve(size);
+    out.resize(size);
 
-    uint16_t c = firstCluster;
-    while (c >= 0x0002 && c < 0xFFF8) {
-        auto off = offset_of_cluster_(c);
-        std::vector<uint8_t> buf(bytesPerCluster_);
-        read_exact(fs_, off, buf.data(), buf.size());
-        size_t toCopy = std::min<uint32_t>(static_cast<uint32_t>(buf.size()), size - static_cast<uint32_t>(out.size()));
-        out.insert(out.end(), buf.begin(), buf.begin() + static_cast<long>(toCopy));
-        if (out.size() >= size) break;
-        c = read_fat(c);
-    }
-    // pode haver lixo no cluster final; já limitado por size
+    // pode haver lixo no cluster final; o leitor já limita por size
+    FileReader reader(*this, chain_of_(firstCluster, size), size, false);
+    out.resize(reader.read(out.data(), out.size()));
     return out;
 }
 
-void FAT16Image::write_file_data(const std::vector<uint8_t>& data, const std::vector<uint16_t>& chain) {
+void FAT16Image::write_file_data_(const std::vector<uint8_t>& data, const std::vector<uint16_t>& chain) {
     if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
     size_t written = 0;
     for (auto c : chain) {
         auto off = offset_of_cluster_(c);
         size_t toWrite = std::min<std::size_t>(bytesPerCluster_, data.size() - written);
         if (toWrite == 0) {
-            // zera cluster extra
-            std::vector<uint8_t> zero(bytesPerCluster_, 0);
-            write_exact(fs_, off, zero.data(), zero.size());
+            // zera cluster extra (um buraco no host já é lido como zeros)
+            if (!is_hole_(off, bytesPerCluster_)) {
+                std::vector<uint8_t> zero(bytesPerCluster_, 0);
+                write_exact(fd_, off, zero.data(), zero.size());
+            }
         } else {
-            write_exact(fs_, off, data.data() + static_cast<long>(written), toWrite);
-            if (toWrite < bytesPerCluster_) {
+            write_exact(fd_, off, data.data() + static_cast<long>(written), toWrite);
+            if (toWrite < bytesPerCluster_ &&
+                !is_hole_(off + static_cast<std::streamoff>(toWrite), bytesPerCluster_ - toWrite)) {
                 std::vector<uint8_t> zero(bytesPerCluster_ - toWrite, 0);
-                write_exact(fs_, off + static_cast<std::streamoff>(toWrite), zero.data(), zero.size());
+                write_exact(fd_, off + static_cast<std::streamoff>(toWrite), zero.data(), zero.size());
             }
         }
         written += toWrite;
@@ -206,137 +361,237 @@ size_t FAT16Image::root_dir_bytes_() const {
     return static_cast<size_t>(rootDirSectors_) * bpb_.bytesPerSector;
 }
 
-std::vector<DirectoryEntry> FAT16Image::read_root_dir(std::vector<uint8_t>* rawOut) {
-    auto size = root_dir_bytes_();
-    std::vector<uint8_t> raw(size);
-    read_exact(fs_, root_dir_offset_(), raw.data(), raw.size());
-    if (rawOut) *rawOut = raw;
-
-    std::vector<DirectoryEntry> entries;
-    for (size_t i = 0; i + 32 <= raw.size(); i += 32) {
-        DirectoryEntry e = DirectoryEntry::parse(&raw[i]);
-        entries.push_back(e);
-        if (e.isUnused()) {
-            // Observação: entradas após 0x00 são livres segundo FAT, mas mantemos todas para edição
-        }
-    }
-    return entries;
+void FAT16Image::load_root_dir_() {
+    rootDir_.resize(root_dir_bytes_());
+    read_exact(fd_, root_dir_offset_(), rootDir_.data(), rootDir_.size());
 }
 
 void FAT16Image::write_root_entry(size_t index, const DirectoryEntry& e) {
     if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
     if (index * 32 >= root_dir_bytes_()) throw std::runtime_error("Índice de entrada inválido");
-    std::array<uint8_t, 32> raw{};
-    e.serialize(raw.data());
-    write_exact(fs_, root_dir_offset_() + static_cast<std::streamoff>(index * 32), raw.data(), raw.size());
+    uint8_t* raw = rootDir_.data() + index * 32;
+    e.serialize(raw);
+    write_exact(fd_, root_dir_offset_() + static_cast<std::streamoff>(index * 32), raw, 32);
 }
 
-int FAT16Image::find_entry_index_by_name11(const std::array<char,11>& name11) {
-    std::vector<uint8_t> raw;
-    auto entries = read_root_dir(&raw);
-    for (size_t i = 0; i < entries.size(); ++i) {
-        const auto& e = entries[i];
-        if (e.isLFN() || e.isVolume() || e.isDirectory() || e.isDeleted()) continue;
-        if (std::memcmp(e.name.data(), name11.data(), 11) == 0) return static_cast<int>(i);
+int FAT16Image::find_entry_index_(const std::array<char,11>& name11) const {
+    auto dir = root_dir_();
+    auto key = reinterpret_cast<const uint8_t*>(name11.data());
+    size_t i = 0;
+    while ((i = scan::find_name11(dir.data(), i, dir.size(), key)) < dir.size()) {
+        auto v = dir[i];
+        if (!(v.isLFN() || v.isVolume() || v.isDirectory() || v.isDeleted())) return static_cast<int>(i);
+        ++i;
     }
     return -1;
 }
 
-int FAT16Image::find_free_dir_index() {
-    std::vector<uint8_t> raw;
-    auto entries = read_root_dir(&raw);
-    for (size_t i = 0; i < entries.size(); ++i) {
-        const auto& e = entries[i];
-        if (e.isDeleted() || e.isUnused()) return static_cast<int>(i);
+int FAT16Image::find_free_dir_index_() const {
+    auto dir = root_dir_();
+    for (size_t i = 0; i < dir.size(); ++i) {
+        if (dir[i].isDeleted()) return static_cast<int>(i);
     }
-    return -1;
+    // o próprio marcador de fim (0x00) é um slot livre
+    return dir.size() < dir.capacity() ? static_cast<int>(dir.size()) : -1;
 }
 
-void FAT16Image::free_chain(uint16_t firstCluster) {
+void FAT16Image::free_chain_(uint16_t firstCluster, std::vector<uint16_t>* freed) {
     if (!rw_ || firstCluster == 0) return;
     uint16_t c = firstCluster;
     while (c >= 2 && c < 0xFFF8) {
-        uint16_t next = read_fat(c);
-        write_fat(c, 0x0000);
+        uint16_t next = read_fat_(c);
+        write_fat_(c, 0x0000);
+        if (freed) freed->push_back(c);
         if (next >= 0xFFF8) break;
         c = next;
     }
 }
 
+HoleStats FAT16Image::punch_runs_(const std::vector<FreeRun>& runs) {
+    HoleStats st{};
+#ifdef FAT16_HAVE_PUNCH_HOLE
+    // só blocos inteiros do host são liberados; as pontas parciais ficam de fora
+    struct stat sb{};
+    off_t blk = (::fstat(fd_, &sb) == 0 && sb.st_blksize > 0) ? static_cast<off_t>(sb.st_blksize) : 4096;
+    for (const auto& r : runs) {
+        off_t first = static_cast<off_t>(offset_of_cluster_(static_cast<uint16_t>(r.start)));
+        off_t last = first + static_cast<off_t>(r.length) * bytesPerCluster_;
+        off_t off = (first + blk - 1) / blk * blk;
+        off_t end = last / blk * blk;
+        if (off >= end) continue;
+
+        // conta só o que ainda está alocado; trechos já buracos (ex.: trim repetido) não contam
+        uint64_t mapped = data_bytes_(off, static_cast<size_t>(end - off));
+        if (mapped == 0) continue;
+        if (::fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, off, end - off) != 0) {
+            if (errno == EOPNOTSUPP) throw std::runtime_error("Sistema de arquivos do host não suporta liberar blocos");
+            throw std::runtime_error(std::string("Falha no fallocate: ") + std::strerror(errno));
+        }
+        ++st.ranges;
+        st.bytes += mapped;
+    }
+#else
+    if (!runs.empty()) throw std::runtime_error("Liberação de blocos no host não suportada nesta plataforma");
+#endif
+    return st;
+}
+
+uint64_t FAT16Image::data_bytes_(std::streamoff off, size_t len) const {
+#ifdef FAT16_HAVE_PUNCH_HOLE
+    // alterna SEEK_DATA/SEEK_HOLE somando os trechos com dados dentro de [off, off+len)
+    off_t pos = static_cast<off_t>(off);
+    off_t end = pos + static_cast<off_t>(len);
+    uint64_t total = 0;
+    while (pos < end) {
+        off_t data = ::lseek(fd_, pos, SEEK_DATA);
+        if (data < 0 || data >= end) break; // ENXIO: só buraco até o fim do arquivo
+        off_t hole = ::lseek(fd_, data, SEEK_HOLE);
+        if (hole < 0) hole = end;
+        total += static_cast<uint64_t>(std::min(hole, end) - data);
+        pos = hole;
+    }
+    return total;
+#else
+    // sem SEEK_DATA, considera o intervalo todo alocado
+    (void)off;
+    return len;
+#endif
+}
+
+bool FAT16Image::is_hole_(std::streamoff off, size_t len) const {
+#ifdef FAT16_HAVE_PUNCH_HOLE
+    return data_bytes_(off, len) == 0;
+#else
+    (void)off;
+    (void)len;
+    return false;
+#endif
+}
+
+HoleStats FAT16Image::trim() {
+    if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
+    std::unique_lock<RwLock> lock(mu_);
+    return punch_runs_(scan::free_runs(fat_.data(), 2, fat_.size()));
+}
+
+// API pública de baixo nível: trava e delega para as versões sem trava
+uint16_t FAT16Image::read_fat(uint16_t cluster) {
+    std::shared_lock<RwLock> lock(mu_);
+    return read_fat_(cluster);
+}
+
+void FAT16Image::write_fat(uint16_t cluster, uint16_t value) {
+    std::unique_lock<RwLock> lock(mu_);
+    write_fat_(cluster, value);
+}
+
+std::vector<uint16_t> FAT16Image::allocate_chain(size_t count) {
+    std::unique_lock<RwLock> lock(mu_);
+    return allocate_chain_(count);
+}
+
+void FAT16Image::free_chain(uint16_t firstCluster) {
+    std::unique_lock<RwLock> lock(mu_);
+    free_chain_(firstCluster);
+}
+
+std::vector<uint8_t> FAT16Image::read_file_data(uint16_t firstCluster, uint32_t size) {
+    std::shared_lock<RwLock> lock(mu_);
+    return read_file_data_(firstCluster, size);
+}
+
+void FAT16Image::write_file_data(const std::vector<uint8_t>& data, const std::vector<uint16_t>& chain) {
+    std::unique_lock<RwLock> lock(mu_);
+    write_file_data_(data, chain);
+}
+
+int FAT16Image::find_entry_index_by_name11(const std::array<char,11>& name11) {
+    std::shared_lock<RwLock> lock(mu_);
+    return find_entry_index_(name11);
+}
+
+int FAT16Image::find_free_dir_index() {
+    std::shared_lock<RwLock> lock(mu_);
+    return find_free_dir_index_();
+}
+
+DirectoryEntry FAT16Image::get_entry_by_name(const std::string& name) {
+    std::shared_lock<RwLock> lock(mu_);
+    return get_entry_(name);
+}
+
 // Operações de alto nível
 std::vector<std::pair<std::string, uint32_t>> FAT16Image::list_root_files() {
-    auto entries = read_root_dir(nullptr);
+    std::shared_lock<RwLock> lock(mu_);
     std::vector<std::pair<std::string, uint32_t>> out;
-    for (const auto& e : entries) {
-        if (e.isLFN() || e.isVolume() || e.isDirectory() || e.isDeleted() || e.isUnused()) continue;
-        out.emplace_back(e.displayName(), e.fileSize);
+    for (auto v : root_dir_()) {
+        if (!v.isFile()) continue;
+        char name[13];
+        size_t n = v.displayName(name);
+        out.emplace_back(std::string(name, n), v.fileSize());
     }
     return out;
 }
 
-DirectoryEntry FAT16Image::get_entry_by_name(const std::string& name) {
+DirectoryEntry FAT16Image::get_entry_(const std::string& name) const {
     auto n11 = make_83_name(name);
-    int idx = find_entry_index_by_name11(n11);
+    int idx = find_entry_index_(n11);
     if (idx < 0) throw std::runtime_error("Arquivo não encontrado: " + name);
-    std::vector<uint8_t> raw;
-    auto entries = read_root_dir(&raw);
-    return entries[static_cast<size_t>(idx)];
+    return root_dir_()[static_cast<size_t>(idx)].entry();
 }
 
 void FAT16Image::rename_file(const std::string& oldName, const std::string& newName) {
     auto old11 = make_83_name(oldName);
     auto new11 = make_83_name(newName);
-    int oldIdx = find_entry_index_by_name11(old11);
+    std::unique_lock<RwLock> lock(mu_);
+    int oldIdx = find_entry_index_(old11);
     if (oldIdx < 0) throw std::runtime_error("Arquivo não encontrado: " + oldName);
-    if (find_entry_index_by_name11(new11) >= 0) throw std::runtime_error("Já existe arquivo com este nome: " + newName);
+    if (find_entry_index_(new11) >= 0) throw std::runtime_error("Já existe arquivo com este nome: " + newName);
 
-    std::vector<uint8_t> raw;
-    auto entries = read_root_dir(&raw);
-    DirectoryEntry e = entries[static_cast<size_t>(oldIdx)];
+    DirectoryEntry e = root_dir_()[static_cast<size_t>(oldIdx)].entry();
     std::memcpy(e.name.data(), new11.data(), 11);
 
     write_root_entry(static_cast<size_t>(oldIdx), e);
 }
 
-void FAT16Image::remove_file(const std::string& name) {
+HoleStats FAT16Image::remove_file(const std::string& name, bool punchHoles) {
     auto n11 = make_83_name(name);
-    int idx = find_entry_index_by_name11(n11);
+    std::unique_lock<RwLock> lock(mu_);
+    int idx = find_entry_index_(n11);
     if (idx < 0) throw std::runtime_error("Arquivo não encontrado: " + name);
 
-    std::vector<uint8_t> raw;
-    auto entries = read_root_dir(&raw);
-    DirectoryEntry e = entries[static_cast<size_t>(idx)];
+    DirectoryEntry e = root_dir_()[static_cast<size_t>(idx)].entry();
 
     // libera cadeia
-    if (e.firstCluster() != 0) free_chain(e.firstCluster());
+    std::vector<uint16_t> freed;
+    if (e.firstCluster() != 0) free_chain_(e.firstCluster(), punchHoles ? &freed : nullptr);
 
     // marca deletado
     e.name[0] = 0xE5;
     write_root_entry(static_cast<size_t>(idx), e);
-}
-
-void FAT16Image::add_file(const std::string& hostPath, const std::string& targetName) {
-    // carrega arquivo do host
-    std::ifstream in(hostPath, std::ios::binary);
-    if (!in) throw std::runtime_error("Não foi possível abrir arquivo local: " + hostPath);
-    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
 
-    auto n11 = make_83_name(targetName.empty() ? hostPath : targetName);
-
-    if (find_entry_index_by_name11(n11) >= 0) {
-        throw std::runtime_error("Já existe arquivo com este nome no diretório raiz");
+    if (freed.empty()) return {};
+    // une clusters adjacentes em intervalos maiores antes de chamar o fallocate
+    std::sort(freed.begin(), freed.end());
+    std::vector<FreeRun> runs;
+    for (auto c : freed) {
+        if (!runs.empty() && runs.back().start + runs.back().length == c) ++runs.back().length;
+        else runs.push_back({ c, 1 });
     }
+    try {
+        return punch_runs_(runs);
+    } catch (const std::exception& ex) {
+        throw std::runtime_error(std::string("Arquivo removido, mas os clusters não foram liberados no host: ") + ex.what());
+    }
+}
 
-    int freeIdx = find_free_dir_index();
-    if (freeIdx < 0) throw std::runtime_error("Diretório raiz cheio");
-
+static DirectoryEntry new_file_entry(const std::array<char,11>& n11, uint32_t size, std::time_t t) {
     DirectoryEntry e{};
     std::memcpy(e.name.data(), n11.data(), 11);
     e.attr = ATTR_ARCHIVE; // arquivo normal
 
     // timestamps
-    auto now = std::time(nullptr);
-    auto fat = from_time_t(now);
+    auto fat = from_time_t(t);
     e.crtTimeTenth = fat.tenth;
     e.crtTime = fat.time;
     e.crtDate = fat.date;
@@ -344,7 +599,28 @@ void FAT16Image::add_file(const std::string& hostPath, const std::string& target
     e.wrtTime = fat.time;
     e.wrtDate = fat.date;
 
-    e.fileSize = static_cast<uint32_t>(data.size());
+    e.fileSize = size;
+    return e;
+}
+
+void FAT16Image::add_file(const std::string& hostPath, const std::string& targetName) {
+    // carrega arquivo do host
+    std::ifstream in(hostPath, std::ios::binary);
+    if (!in) throw std::runtime_error("Não foi possível abrir arquivo local: " + hostPath);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    auto n11 = make_83_name(targetName.empty() ? hostPath : targetName);
+
+    // leitura do host fica fora da trava; daqui em diante a operação é exclusiva
+    std::unique_lock<RwLock> lock(mu_);
+    if (find_entry_index_(n11) >= 0) {
+        throw std::runtime_error("Já existe arquivo com este nome no diretório raiz");
+    }
+
+    int freeIdx = find_free_dir_index_();
+    if (freeIdx < 0) throw std::runtime_error("Diretório raiz cheio");
+
+    DirectoryEntry e = new_file_entry(n11, static_cast<uint32_t>(data.size()), std::time(nullptr));
 
     if (data.empty()) {
         e.firstClusLO = 0; // arquivos vazios podem ter cluster 0
@@ -354,20 +630,217 @@ void FAT16Image::add_file(const std::string& hostPath, const std::string& target
 
     // clusters necessários
     size_t clusters = (data.size() + bytesPerCluster_ - 1) / bytesPerCluster_;
-    auto chain = allocate_chain(clusters);
+    auto chain = allocate_chain_(clusters);
     e.firstClusLO = chain.front();
 
-    write_file_data(data, chain);
+    write_file_data_(data, chain);
     write_root_entry(static_cast<size_t>(freeIdx), e);
 }
 
+void FAT16Image::flush_fat_range_(size_t first, size_t last) {
+    // grava fat_[first..last] de uma vez em cada cópia da FAT
+    std::vector<uint8_t> raw((last - first + 1) * 2);
+    for (size_t c = first; c <= last; ++c) wr_le16(raw.data() + (c - first) * 2, fat_[c]);
+    for (int i = 0; i < bpb_.numFATs; ++i) {
+        auto fatSector = firstFATSector_ + static_cast<uint32_t>(i) * bpb_.fatSize16;
+        auto off = offset_of_sector_(fatSector) + static_cast<std::streamoff>(first) * 2;
+        write_exact(fd_, off, raw.data(), raw.size());
+    }
+}
+
+void FAT16Image::flush_root_range_(size_t first, size_t last) {
+    write_exact(fd_, root_dir_offset_() + static_cast<std::streamoff>(first * 32),
+                rootDir_.data() + first * 32, (last - first + 1) * 32);
+}
+
+size_t FAT16Image::import_files(const std::vector<ImportItem>& items) {
+    if (!rw_) throw std::runtime_error("Imagem aberta como somente leitura");
+    if (items.empty()) return 0;
+    std::unique_lock<RwLock> lock(mu_);
+
+    // 1) nomes: sem conflito com o diretório nem dentro do lote
+    std::vector<std::array<char,11>> names;
+    names.reserve(items.size());
+    for (const auto& it : items) {
+        auto n11 = make_83_name(it.targetName);
+        if (find_entry_index_(n11) >= 0) {
+            throw std::runtime_error("Já existe arquivo com este nome no diretório raiz: " + it.targetName);
+        }
+        if (std::find(names.begin(), names.end(), n11) != names.end()) {
+            throw std::runtime_error("Nome 8.3 repetido no lote: " + it.targetName);
+        }
+        names.push_back(n11);
+    }
+
+    // 2) entradas livres do diretório (removidas e, depois delas, a partir do marcador de fim)
+    std::vector<size_t> slots;
+    auto dir = root_dir_();
+    for (size_t i = 0; i < dir.size() && slots.size() < items.size(); ++i) {
+        if (dir[i].isDeleted()) slots.push_back(i);
+    }
+    for (size_t i = dir.size(); i < dir.capacity() && slots.size() < items.size(); ++i) slots.push_back(i);
+    if (slots.size() < items.size()) throw std::runtime_error("Diretório raiz sem entradas livres suficientes");
+
+    // 3) espaço: soma dos clusters contra as sequências livres da FAT
+    std::vector<uint32_t> need(items.size());
+    uint64_t totalNeed = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        need[i] = static_cast<uint32_t>((static_cast<uint64_t>(items[i].size) + bytesPerCluster_ - 1) / bytesPerCluster_);
+        totalNeed += need[i];
+    }
+    auto runs = scan::free_runs(fat_.data(), 2, fat_.size());
+    uint64_t totalFree = 0;
+    for (const auto& r : runs) totalFree += r.length;
+    if (totalNeed > totalFree) {
+        throw std::runtime_error("Espaço insuficiente: " + std::to_string(totalNeed) + " clusters necessários, " +
+                                 std::to_string(totalFree) + " livres");
+    }
+
+    // 4) planejamento: maiores primeiro, cada um na menor sequência que o comporta;
+    //    se nenhuma comportar, espalha pelas maiores sequências restantes
+    std::vector<std::vector<FreeRun>> extents(items.size());
+    std::vector<size_t> order(items.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&need](size_t a, size_t b) { return need[a] > need[b]; });
+    for (size_t i : order) {
+        uint32_t left = need[i];
+        if (left == 0) continue;
+        FreeRun* best = nullptr;
+        for (auto& r : runs) {
+            if (r.length >= left && (!best || r.length < best->length)) best = &r;
+        }
+        while (left > 0) {
+            FreeRun* r = best;
+            if (!r) {
+                r = &*std::max_element(runs.begin(), runs.end(),
+                                       [](const FreeRun& a, const FreeRun& b) { return a.length < b.length; });
+            }
+            uint32_t k = std::min(left, r->length);
+            extents[i].push_back({ r->start, k });
+            r->start += k;
+            r->length -= k;
+            left -= k;
+        }
+    }
+
+    // 5) dados: trechos ordenados por cluster, gravados em blocos sequenciais
+    struct Segment { uint32_t cluster; uint32_t count; size_t item; uint64_t fileOffset; };
+    std::vector<Segment> segments;
+    for (size_t i = 0; i < items.size(); ++i) {
+        uint64_t off = 0;
+        for (const auto& x : extents[i]) {
+            segments.push_back({ x.start, x.length, i, off });
+            off += static_cast<uint64_t>(x.length) * bytesPerCluster_;
+        }
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& a, const Segment& b) { return a.cluster < b.cluster; });
+
+    const size_t stageClusters = std::max<size_t>(1, (1u << 20) / bytesPerCluster_);
+    std::vector<uint8_t> stage(stageClusters * bytesPerCluster_);
+    uint32_t stageFirst = 0;
+    size_t staged = 0;
+    auto flush_stage = [&]() {
+        if (staged == 0) return;
+        write_exact(fd_, offset_of_cluster_(static_cast<uint16_t>(stageFirst)), stage.data(), staged * bytesPerCluster_);
+        staged = 0;
+    };
+
+    std::ifstream in;
+    std::string inPath;
+    for (const auto& seg : segments) {
+        const auto& it = items[seg.item];
+        if (staged > 0 && stageFirst + staged != seg.cluster) flush_stage();
+        if (inPath != it.hostPath) {
+            in.close();
+            in.clear();
+            in.open(it.hostPath, std::ios::binary);
+            if (!in) throw std::runtime_error("Não foi possível abrir arquivo local: " + it.hostPath);
+            inPath = it.hostPath;
+        }
+
+        uint32_t done = 0;
+        while (done < seg.count) {
+            if (staged == stageClusters) flush_stage();
+            if (staged == 0) stageFirst = seg.cluster + done;
+            size_t k = std::min<size_t>(seg.count - done, stageClusters - staged);
+            uint64_t fileOff = seg.fileOffset + static_cast<uint64_t>(done) * bytesPerCluster_;
+            size_t bytes = static_cast<size_t>(std::min<uint64_t>(k * bytesPerCluster_, it.size - fileOff));
+
+            uint8_t* dst = stage.data() + staged * bytesPerCluster_;
+            in.seekg(static_cast<std::streamoff>(it.offset + fileOff));
+            in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(bytes));
+            if (!in) throw std::runtime_error("Falha ao ler arquivo local: " + it.hostPath);
+            std::memset(dst + bytes, 0, k * bytesPerCluster_ - bytes); // zera o fim do último cluster
+
+            staged += k;
+            done += static_cast<uint32_t>(k);
+        }
+    }
+    flush_stage();
+
+    // 6) FAT: encadeia as extensões em memória e grava o intervalo alterado uma vez
+    size_t fatLo = fat_.size(), fatHi = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        uint32_t prev = 0;
+        for (const auto& x : extents[i]) {
+            for (uint32_t c = x.start; c < x.start + x.length; ++c) {
+                if (prev) fat_[prev] = static_cast<uint16_t>(c);
+                prev = c;
+                fatLo = std::min<size_t>(fatLo, c);
+                fatHi = std::max<size_t>(fatHi, c);
+            }
+        }
+        if (prev) fat_[prev] = 0xFFFF;
+    }
+    if (fatLo <= fatHi) flush_fat_range_(fatLo, fatHi);
+
+    // 7) diretório: preenche as entradas em memória e grava o intervalo uma vez
+    std::time_t now = std::time(nullptr);
+    for (size_t i = 0; i < items.size(); ++i) {
+        DirectoryEntry e = new_file_entry(names[i], items[i].size, items[i].mtime ? items[i].mtime : now);
+        e.firstClusLO = extents[i].empty() ? 0 : static_cast<uint16_t>(extents[i].front().start);
+        e.serialize(rootDir_.data() + slots[i] * 32);
+    }
+    auto [slotLo, slotHi] = std::minmax_element(slots.begin(), slots.end());
+    flush_root_range_(*slotLo, *slotHi);
+
+    return items.size();
+}
+
 std::vector<uint8_t> FAT16Image::read_file_by_name(const std::string& name) {
-    auto e = get_entry_by_name(name);
-    return read_file_data(e.firstCluster(), e.fileSize);
+    std::shared_lock<RwLock> lock(mu_);
+    auto e = get_entry_(name);
+    return read_file_data_(e.firstCluster(), e.fileSize);
+}
+
+void FAT16Image::visit_root_files(const std::function<void(const DirectoryEntry&, FileReader&)>& fn) const {
+    // copia entradas e cadeias de uma vez para não segurar a trava enquanto fn
+    // espera (por exemplo, por um buffer livre na exportação)
+    std::vector<std::pair<DirectoryEntry, std::vector<uint16_t>>> files;
+    {
+        std::shared_lock<RwLock> lock(mu_);
+        for (auto v : root_dir_()) {
+            if (!v.isFile()) continue;
+            DirectoryEntry e = v.entry();
+            std::vector<uint16_t> chain;
+            if (e.firstCluster()) chain = chain_of_(e.firstCluster(), e.fileSize);
+            files.emplace_back(e, std::move(chain));
+        }
+    }
+    for (auto& [e, chain] : files) {
+        uint32_t size = e.firstCluster() ? e.fileSize : 0;
+        FileReader reader(*this, std::move(chain), size, true);
+        fn(e, reader);
+    }
 }
 
 FileAttributes FAT16Image::get_attributes(const std::string& name) {
-    auto e = get_entry_by_name(name);
+    DirectoryEntry e;
+    {
+        std::shared_lock<RwLock> lock(mu_);
+        e = get_entry_(name);
+    }
     FileAttributes a{};
     a.readOnly = (e.attr & ATTR_READ_ONLY) != 0;
     a.hidden   = (e.attr & ATTR_HIDDEN) != 0;
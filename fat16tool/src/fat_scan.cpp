@@ -0,0 +1,232 @@
+#include "fat_scan.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FAT16_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FAT16_SCAN_SSE2 1
+#endif
+
+namespace fat16 {
+namespace scan {
+
+// Utilitários de bits (builtins quando disponíveis)
+static inline unsigned ctz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(v));
+#else
+    unsigned n = 0;
+    while ((v & 1u) == 0) { v >>= 1; ++n; }
+    return n;
+#endif
+}
+
+static inline unsigned popcount64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(v));
+#else
+    unsigned n = 0;
+    while (v) { v &= v - 1; ++n; }
+    return n;
+#endif
+}
+
+static inline unsigned log2_floor(uint32_t v) {
+    unsigned n = 0;
+    while (v >>= 1) ++n;
+    return n;
+}
+
+// Compara 64 entradas da FAT e devolve as máscaras (bit i = entrada i)
+// de clusters livres e defeituosos. n < 64 só ocorre no último bloco.
+static void masks_64(const uint16_t* p, size_t n, uint64_t& freeMask, uint64_t& badMask) {
+    freeMask = 0;
+    badMask = 0;
+    size_t i = 0;
+#if defined(FAT16_SCAN_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bad = _mm256_set1_epi16(static_cast<short>(FAT_BAD));
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 16));
+        // packs intercala as lanes de 128 bits; o permute restaura a ordem
+        __m256i f = _mm256_permute4x64_epi64(
+            _mm256_packs_epi16(_mm256_cmpeq_epi16(a, zero), _mm256_cmpeq_epi16(b, zero)), 0xD8);
+        __m256i d = _mm256_permute4x64_epi64(
+            _mm256_packs_epi16(_mm256_cmpeq_epi16(a, bad), _mm256_cmpeq_epi16(b, bad)), 0xD8);
+        freeMask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(f))) << i;
+        badMask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(d))) << i;
+    }
+#elif defined(FAT16_SCAN_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bad = _mm_set1_epi16(static_cast<short>(FAT_BAD));
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 8));
+        __m128i f = _mm_packs_epi16(_mm_cmpeq_epi16(a, zero), _mm_cmpeq_epi16(b, zero));
+        __m128i d = _mm_packs_epi16(_mm_cmpeq_epi16(a, bad), _mm_cmpeq_epi16(b, bad));
+        freeMask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(f))) << i;
+        badMask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(d))) << i;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (p[i] == FAT_FREE) freeMask |= uint64_t{1} << i;
+        else if (p[i] == FAT_BAD) badMask |= uint64_t{1} << i;
+    }
+}
+
+const char* kernel_name() {
+#if defined(FAT16_SCAN_AVX2)
+    return "avx2";
+#elif defined(FAT16_SCAN_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+size_t find_free(const uint16_t* fat, size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(FAT16_SCAN_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 16 <= end; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fat + i));
+        auto m = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, zero)));
+        if (m) return i + ctz64(m) / 2;
+    }
+#elif defined(FAT16_SCAN_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= end; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fat + i));
+        auto m = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero)));
+        if (m) return i + ctz64(m) / 2;
+    }
+#endif
+    for (; i < end; ++i) {
+        if (fat[i] == FAT_FREE) return i;
+    }
+    return end;
+}
+
+// Percorre fat[begin, end) em blocos de 64 entradas; onBlock recebe as máscaras
+// de cada bloco e onRun(início, tamanho) cada sequência maximal de clusters livres
+template <class OnBlock, class OnRun>
+static void walk_free_runs(const uint16_t* fat, size_t begin, size_t end, OnBlock&& onBlock, OnRun&& onRun) {
+    size_t runStart = 0;
+    uint32_t run = 0;
+    auto close_run = [&]() {
+        if (run == 0) return;
+        onRun(runStart, run);
+        run = 0;
+    };
+
+    for (size_t base = begin; base < end; base += 64) {
+        size_t n = std::min<size_t>(64, end - base);
+        uint64_t freeMask = 0, badMask = 0;
+        masks_64(fat + base, n, freeMask, badMask);
+        onBlock(freeMask, badMask);
+
+        // Sequências livres a partir do bitmap: blocos cheios/vazios são o caso comum
+        if (n == 64 && freeMask == ~uint64_t{0}) {
+            if (run == 0) runStart = base;
+            run += 64;
+            continue;
+        }
+        if (freeMask == 0) { close_run(); continue; }
+        unsigned pos = 0;
+        while (pos < n) {
+            uint64_t rest = freeMask >> pos;
+            if (rest & 1u) {
+                unsigned ones = ~rest ? ctz64(~rest) : 64 - pos;
+                if (ones > n - pos) ones = static_cast<unsigned>(n - pos);
+                if (run == 0) runStart = base + pos;
+                run += ones;
+                pos += ones;
+            } else {
+                close_run();
+                if (rest == 0) break;
+                pos += ctz64(rest);
+            }
+        }
+    }
+    close_run();
+}
+
+FreeSpaceStats free_space(const uint16_t* fat, size_t begin, size_t end) {
+    FreeSpaceStats st{};
+    if (end <= begin) return st;
+    st.totalClusters = static_cast<uint32_t>(end - begin);
+
+    walk_free_runs(fat, begin, end,
+        [&st](uint64_t freeMask, uint64_t badMask) {
+            st.freeClusters += popcount64(freeMask);
+            st.badClusters += popcount64(badMask);
+        },
+        [&st](size_t, uint32_t len) {
+            if (len > st.largestFreeRun) st.largestFreeRun = len;
+            ++st.freeRuns;
+            ++st.runHistogram[log2_floor(len)];
+        });
+
+    st.usedClusters = st.totalClusters - st.freeClusters - st.badClusters;
+    return st;
+}
+
+std::vector<FreeRun> free_runs(const uint16_t* fat, size_t begin, size_t end) {
+    std::vector<FreeRun> runs;
+    walk_free_runs(fat, begin, end,
+        [](uint64_t, uint64_t) {},
+        [&runs](size_t start, uint32_t len) { runs.push_back({ static_cast<uint32_t>(start), len }); });
+    return runs;
+}
+
+size_t find_name11(const uint8_t* dir, size_t begin, size_t end, const uint8_t name11[11]) {
+    size_t i = begin;
+#if defined(FAT16_SCAN_AVX2) || defined(FAT16_SCAN_SSE2)
+    // Os 16 primeiros bytes de cada slot contêm o nome; compara só os 11 bits baixos da máscara
+    uint8_t pat[16] = {};
+    std::memcpy(pat, name11, 11);
+    constexpr unsigned kNameMask = 0x7FF;
+#if defined(FAT16_SCAN_AVX2)
+    // Dois slots por registrador, quatro slots por iteração
+    const __m256i p = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pat)));
+    auto load2 = [dir](size_t s) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dir + s * 32));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dir + (s + 1) * 32));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    };
+    for (; i + 4 <= end; i += 4) {
+        auto m01 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load2(i), p)));
+        auto m23 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load2(i + 2), p)));
+        unsigned hit = static_cast<unsigned>((m01 & kNameMask) == kNameMask) |
+                       static_cast<unsigned>(((m01 >> 16) & kNameMask) == kNameMask) << 1 |
+                       static_cast<unsigned>((m23 & kNameMask) == kNameMask) << 2 |
+                       static_cast<unsigned>(((m23 >> 16) & kNameMask) == kNameMask) << 3;
+        if (hit) return i + ctz64(hit);
+    }
+#else
+    // Quatro slots por iteração
+    const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pat));
+    auto eq = [dir, &p](size_t s) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dir + s * 32));
+        return (static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, p))) & kNameMask) == kNameMask;
+    };
+    for (; i + 4 <= end; i += 4) {
+        unsigned hit = static_cast<unsigned>(eq(i)) | static_cast<unsigned>(eq(i + 1)) << 1 |
+                       static_cast<unsigned>(eq(i + 2)) << 2 | static_cast<unsigned>(eq(i + 3)) << 3;
+        if (hit) return i + ctz64(hit);
+    }
+#endif
+#endif
+    for (; i < end; ++i) {
+        if (std::memcmp(dir + i * 32, name11, 11) == 0) return i;
+    }
+    return end;
+}
+
+} // namespace scan
+} // namespace fat16
@@ -0,0 +1,107 @@
+#include "import_source.hpp"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fat16 {
+
+namespace fs = std::filesystem;
+
+static std::vector<ImportItem> scan_directory(const fs::path& dir) {
+    std::vector<ImportItem> items;
+    for (const auto& ent : fs::directory_iterator(dir)) {
+        if (!ent.is_regular_file()) continue;
+        auto size = ent.file_size();
+        if (size > UINT32_MAX) throw std::runtime_error("Arquivo grande demais para FAT16: " + ent.path().string());
+        ImportItem it;
+        it.targetName = ent.path().filename().string();
+        it.hostPath = ent.path().string();
+        it.size = static_cast<uint32_t>(size);
+        items.push_back(std::move(it));
+    }
+    // ordem estável, independente do sistema de arquivos do host
+    std::sort(items.begin(), items.end(),
+              [](const ImportItem& a, const ImportItem& b) { return a.targetName < b.targetName; });
+    return items;
+}
+
+static uint64_t tar_number(const char* field, size_t width) {
+    size_t i = 0;
+    while (i < width && field[i] == ' ') ++i; // tar antigo alinha os números com espaços à esquerda
+    uint64_t v = 0;
+    for (; i < width && field[i] != '\0' && field[i] != ' '; ++i) {
+        if (field[i] < '0' || field[i] > '7') throw std::runtime_error("Cabeçalho tar inválido");
+        v = (v << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+    return v;
+}
+
+// Soma dos bytes do cabeçalho com o campo de checksum (148..155) contado como espaços;
+// aceita a soma com e sem sinal, como o GNU tar
+static bool tar_checksum_ok(const std::array<char, 512>& h) {
+    uint64_t stored = tar_number(h.data() + 148, 8);
+    uint64_t sumU = 0;
+    int64_t sumS = 0;
+    for (size_t i = 0; i < h.size(); ++i) {
+        char c = (i >= 148 && i < 156) ? ' ' : h[i];
+        sumU += static_cast<unsigned char>(c);
+        sumS += static_cast<signed char>(c);
+    }
+    return stored == sumU || static_cast<int64_t>(stored) == sumS;
+}
+
+static std::vector<ImportItem> scan_tar(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Não foi possível abrir arquivo local: " + path);
+    uint64_t fileSize = fs::file_size(path);
+
+    std::vector<ImportItem> items;
+    std::array<char, 512> h{};
+    uint64_t pos = 0;
+    bool sawEnd = false;
+    while (true) {
+        in.read(h.data(), h.size());
+        auto got = in.gcount();
+        if (got == 0) break;
+        if (got != static_cast<std::streamsize>(h.size())) throw std::runtime_error("Arquivo tar truncado: " + path);
+        pos += h.size();
+
+        // bloco zerado marca o fim
+        if (std::all_of(h.begin(), h.end(), [](char c) { return c == '\0'; })) {
+            sawEnd = true;
+            break;
+        }
+        if (!tar_checksum_ok(h)) throw std::runtime_error("Cabeçalho tar inválido");
+
+        uint64_t size = tar_number(h.data() + 124, 12);
+        if (size > fileSize - pos) throw std::runtime_error("Arquivo tar truncado: " + path);
+        char type = h[156];
+        if (type == '0' || type == '\0') {
+            if (size > UINT32_MAX) throw std::runtime_error("Arquivo grande demais para FAT16 no tar");
+            ImportItem it;
+            it.targetName.assign(h.data(), std::find(h.data(), h.data() + 100, '\0'));
+            it.hostPath = path;
+            it.offset = pos;
+            it.size = static_cast<uint32_t>(size);
+            it.mtime = static_cast<std::time_t>(tar_number(h.data() + 136, 12));
+            items.push_back(std::move(it));
+        }
+        // outros tipos (diretórios, links, cabeçalhos pax) são ignorados
+        pos += (size + 511) / 512 * 512;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(pos));
+    }
+    // sem nenhum cabeçalho nem bloco de fim: não é um tar
+    if (items.empty() && !sawEnd && pos == 0) throw std::runtime_error("Arquivo tar vazio ou inválido: " + path);
+    return items;
+}
+
+std::vector<ImportItem> scan_import_source(const std::string& path) {
+    if (fs::is_directory(path)) return scan_directory(path);
+    if (fs::is_regular_file(path)) return scan_tar(path);
+    throw std::runtime_error("Origem de importação não encontrada: " + path);
+}
+
+} // namespace fat16
@@ -1,9 +1,12 @@
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include "fat16_image.hpp"
+#include "import_source.hpp"
+#include "tar_export.hpp"
 #include "utils.hpp"
 
 using namespace fat16;
@@ -16,7 +19,11 @@ static void usage() {
                  "  attrs <ARQ>\n"
                  "  rename <OLD> <NEW>\n"
                  "  add <CAMINHO_HOST> [NOME_8.3]\n"
-                 "  rm <ARQ>\n";
+                 "  rm <ARQ> [--punch]\n"
+                 "  trim\n"
+                 "  import <DIR_HOST|ARQUIVO_TAR>\n"
+                 "  df\n"
+                 "  export-tar [-|CAMINHO_TAR]\n";
 }
 
 static void print_time(const FatDateTime& dt) {
@@ -42,14 +49,21 @@ int main(int argc, char** argv) {
     std::string cmd = argv[2];
 
     try {
-        bool needsWrite = (cmd == "rename" || cmd == "rm" || cmd == "add");
+        bool needsWrite = (cmd == "rename" || cmd == "rm" || cmd == "add" || cmd == "import" || cmd == "trim");
         FAT16Image fs(img, needsWrite);
 
         if (cmd == "list") {
-            auto files = fs.list_root_files();
-            for (const auto& [name, size] : files) {
-                std::cout << std::left << std::setw(20) << name << " " << size << " bytes\n";
-            }
+            // formata direto das entradas brutas, sem alocar por arquivo
+            fs.with_root_dir([](const DirectoryView& dir) {
+                for (auto v : dir) {
+                    if (!v.isFile()) continue;
+                    char name[13];
+                    v.displayName(name);
+                    char line[64];
+                    int n = std::snprintf(line, sizeof(line), "%-20s %u bytes\n", name, static_cast<unsigned>(v.fileSize()));
+                    std::cout.write(line, n);
+                }
+            });
         } else if (cmd == "cat") {
             if (argc < 4) { usage(); return 1; }
             std::string name = argv[3];
@@ -66,6 +80,50 @@ int main(int argc, char** argv) {
             std::cout << "Sistema: " << (a.system ? "sim" : "não") << "\n";
             std::cout << "Criação: "; print_time(a.creation); std::cout << "\n";
             std::cout << "Modificação: "; print_time(a.modified); std::cout << "\n";
+        } else if (cmd == "import") {
+            if (argc < 4) { usage(); return 1; }
+            auto items = scan_import_source(argv[3]);
+            size_t n = fs.import_files(items);
+            std::cout << n << " arquivo(s) importado(s).\n";
+        } else if (cmd == "trim") {
+            auto holes = fs.trim();
+            std::cout << holes.bytes << " bytes devolvidos ao host em " << holes.ranges << " intervalo(s).\n";
+        } else if (cmd == "df") {
+            auto st = fs.free_space_stats();
+            uint64_t bpc = st.bytesPerCluster;
+            std::cout << "Clusters: " << st.totalClusters << " x " << bpc << " bytes\n";
+            std::cout << "Livres: " << st.freeClusters << " (" << st.freeClusters * bpc << " bytes)\n";
+            std::cout << "Usados: " << st.usedClusters << " (" << st.usedClusters * bpc << " bytes)\n";
+            std::cout << "Defeituosos: " << st.badClusters << "\n";
+            std::cout << "Maior sequência livre: " << st.largestFreeRun << " clusters ("
+                      << st.largestFreeRun * bpc << " bytes)\n";
+            std::cout << "Fragmentos livres: " << st.freeRuns << "\n";
+            for (size_t i = 0; i < st.runHistogram.size(); ++i) {
+                if (st.runHistogram[i] == 0) continue;
+                uint64_t lo = uint64_t{1} << i;
+                uint64_t hi = (uint64_t{1} << (i + 1)) - 1;
+                std::cout << "  " << std::right << std::setw(5) << lo << "-" << std::left << std::setw(5) << hi
+                          << " clusters: " << st.runHistogram[i] << "\n";
+            }
+            std::cout << "Varredura (" << scan::kernel_name() << "): " << st.scanMicros << " us\n";
+        } else if (cmd == "export-tar") {
+            std::string dest = (argc >= 4) ? argv[3] : "-";
+            if (dest == "-") {
+                std::cout.flush();
+                export_tar(fs, stdout);
+            } else {
+                std::FILE* out = std::fopen(dest.c_str(), "wb");
+                if (!out) throw std::runtime_error("Não foi possível criar o arquivo: " + dest);
+                size_t n = 0;
+                try {
+                    n = export_tar(fs, out);
+                } catch (...) {
+                    std::fclose(out);
+                    throw;
+                }
+                if (std::fclose(out) != 0) throw std::runtime_error("Falha ao gravar o arquivo: " + dest);
+                std::cout << n << " arquivo(s) exportado(s) para " << dest << "\n";
+            }
         } else if (cmd == "rename") {
             if (argc < 5) { usage(); return 1; }
             std::string oldN = argv[3];
@@ -73,10 +131,19 @@ int main(int argc, char** argv) {
             fs.rename_file(oldN, newN);
             std::cout << "Renomeado com sucesso.\n";
         } else if (cmd == "rm") {
-            if (argc < 4) { usage(); return 1; }
-            std::string name = argv[3];
-            fs.remove_file(name);
+            // rm <ARQ> [--punch]; a opção pode vir antes ou depois do nome
+            std::string name;
+            bool punch = false;
+            for (int i = 3; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (arg == "--punch" && !punch) punch = true;
+                else if (name.empty() && arg.rfind("--", 0) != 0) name = arg;
+                else { usage(); return 1; }
+            }
+            if (name.empty()) { usage(); return 1; }
+            auto holes = fs.remove_file(name, punch);
             std::cout << "Removido com sucesso.\n";
+            if (punch) std::cout << holes.bytes << " bytes devolvidos ao host em " << holes.ranges << " intervalo(s).\n";
         } else if (cmd == "add") {
             if (argc < 4) { usage(); return 1; }
             std::string host = argv[3];
@@ -0,0 +1,235 @@
+#include "tar_export.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fat16 {
+
+namespace {
+
+constexpr size_t kTarBlock = 512;
+
+// Anel de buffers de tamanho fixo com um produtor e um consumidor.
+// head_ conta buffers publicados e tail_ buffers já escritos; o conteúdo de
+// cada buffer é acessado fora da trava por quem o possui no momento.
+class BufferRing {
+public:
+    BufferRing(size_t count, size_t size)
+        : bufs_(count, std::vector<uint8_t>(size)), lens_(count) {}
+
+    size_t buffer_size() const { return bufs_.front().size(); }
+
+    // Produtor: espera um buffer livre; nullptr se o consumidor desistiu
+    uint8_t* acquire() {
+        std::unique_lock<std::mutex> lock(mu_);
+        notFull_.wait(lock, [this] { return head_ - tail_ < bufs_.size() || failed_; });
+        if (failed_) return nullptr;
+        return bufs_[head_ % bufs_.size()].data();
+    }
+
+    void publish(size_t len) {
+        std::lock_guard<std::mutex> lock(mu_);
+        lens_[head_ % bufs_.size()] = len;
+        ++head_;
+        notEmpty_.notify_one();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mu_);
+        closed_ = true;
+        notEmpty_.notify_one();
+    }
+
+    // Consumidor: próximo buffer cheio; false quando o produtor fechou e não há mais nada
+    bool next(const uint8_t*& data, size_t& len) {
+        std::unique_lock<std::mutex> lock(mu_);
+        notEmpty_.wait(lock, [this] { return head_ > tail_ || closed_; });
+        if (head_ == tail_) return false;
+        data = bufs_[tail_ % bufs_.size()].data();
+        len = lens_[tail_ % bufs_.size()];
+        return true;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mu_);
+        ++tail_;
+        notFull_.notify_one();
+    }
+
+    void fail() {
+        std::lock_guard<std::mutex> lock(mu_);
+        failed_ = true;
+        notFull_.notify_one();
+    }
+
+private:
+    std::vector<std::vector<uint8_t>> bufs_;
+    std::vector<size_t> lens_;
+    std::mutex mu_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    size_t head_{};
+    size_t tail_{};
+    bool closed_{};
+    bool failed_{};
+};
+
+// Lado produtor: preenche o buffer atual do anel e publica quando enche
+class RingWriter {
+public:
+    explicit RingWriter(BufferRing& ring) : ring_(ring) {}
+
+    // Espaço livre no buffer atual (pelo menos 1 byte)
+    uint8_t* space(size_t& avail) {
+        if (!cur_ || used_ == ring_.buffer_size()) {
+            flush();
+            cur_ = ring_.acquire();
+            if (!cur_) throw std::runtime_error("Falha ao escrever o tar");
+        }
+        avail = ring_.buffer_size() - used_;
+        return cur_ + used_;
+    }
+
+    void commit(size_t n) { used_ += n; }
+
+    void put(const void* src, size_t n) {
+        auto p = static_cast<const uint8_t*>(src);
+        while (n > 0) {
+            size_t avail = 0;
+            uint8_t* dst = space(avail);
+            size_t k = std::min(avail, n);
+            std::memcpy(dst, p, k);
+            commit(k);
+            p += k;
+            n -= k;
+        }
+    }
+
+    void zeros(size_t n) {
+        while (n > 0) {
+            size_t avail = 0;
+            uint8_t* dst = space(avail);
+            size_t k = std::min(avail, n);
+            std::memset(dst, 0, k);
+            commit(k);
+            n -= k;
+        }
+    }
+
+    void flush() {
+        if (cur_ && used_ > 0) ring_.publish(used_);
+        cur_ = nullptr;
+        used_ = 0;
+    }
+
+private:
+    BufferRing& ring_;
+    uint8_t* cur_{};
+    size_t used_{};
+};
+
+// Campo numérico octal terminado em NUL, como no ustar
+void tar_octal(char* field, size_t width, uint64_t value) {
+    field[width - 1] = '\0';
+    for (size_t i = width - 1; i-- > 0;) {
+        field[i] = static_cast<char>('0' + (value & 7));
+        value >>= 3;
+    }
+}
+
+void tar_header(const DirectoryEntry& e, uint8_t block[kTarBlock]) {
+    std::memset(block, 0, kTarBlock);
+    char* h = reinterpret_cast<char*>(block);
+
+    char name[13];
+    size_t n = format_display_name(e.name.data(), name);
+    std::memcpy(h + 0, name, n);
+
+    unsigned mode = (e.attr & ATTR_READ_ONLY) ? 0444 : 0644;
+    std::time_t mtime = to_time_t({ e.wrtDate, e.wrtTime, 0 });
+    if (mtime < 0) mtime = 0;
+
+    tar_octal(h + 100, 8, mode);
+    tar_octal(h + 108, 8, 0); // uid
+    tar_octal(h + 116, 8, 0); // gid
+    tar_octal(h + 124, 12, e.fileSize);
+    tar_octal(h + 136, 12, static_cast<uint64_t>(mtime));
+    h[156] = '0'; // arquivo regular
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+
+    // checksum calculado com o próprio campo preenchido por espaços
+    std::memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (size_t i = 0; i < kTarBlock; ++i) sum += block[i];
+    tar_octal(h + 148, 7, sum);
+    h[155] = ' ';
+}
+
+} // namespace
+
+size_t export_tar(const FAT16Image& img, std::FILE* out, const TarExportOptions& opts) {
+    if (opts.bufferCount == 0 || opts.bufferSize == 0 || opts.bufferSize % kTarBlock != 0) {
+        throw std::runtime_error("Configuração de buffers inválida para export-tar");
+    }
+    BufferRing ring(opts.bufferCount, opts.bufferSize);
+
+    // Consumidor: apenas escreve buffers prontos na saída
+    bool writeFailed = false;
+    std::thread writer([&ring, out, &writeFailed] {
+        const uint8_t* data = nullptr;
+        size_t len = 0;
+        while (ring.next(data, len)) {
+            if (std::fwrite(data, 1, len, out) != len) {
+                writeFailed = true;
+                ring.fail();
+                return;
+            }
+            ring.release();
+        }
+        if (std::fflush(out) != 0) writeFailed = true;
+    });
+
+    size_t files = 0;
+    try {
+        RingWriter w(ring);
+        uint8_t header[kTarBlock];
+        img.visit_root_files([&](const DirectoryEntry& e, FAT16Image::FileReader& reader) {
+            tar_header(e, header);
+            w.put(header, sizeof(header));
+
+            // lê as cadeias direto para os buffers do anel
+            uint32_t copied = 0;
+            while (reader.remaining() > 0) {
+                size_t avail = 0;
+                uint8_t* dst = w.space(avail);
+                size_t n = reader.read(dst, avail);
+                if (n == 0) break;
+                w.commit(n);
+                copied += static_cast<uint32_t>(n);
+            }
+            // cadeia truncada: completa com zeros para manter o tamanho declarado
+            w.zeros(e.fileSize - copied);
+            w.zeros((kTarBlock - e.fileSize % kTarBlock) % kTarBlock);
+            ++files;
+        });
+        w.zeros(2 * kTarBlock); // fim do arquivo tar
+        w.flush();
+    } catch (...) {
+        ring.close();
+        writer.join();
+        throw;
+    }
+    ring.close();
+    writer.join();
+
+    if (writeFailed) throw std::runtime_error("Falha ao escrever o tar");
+    return files;
+}
+
+} // namespace fat16
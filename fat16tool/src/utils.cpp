@@ -95,20 +95,31 @@ std::array<char, 11> make_83_name(const std::string& input) {
     return out;
 }
 
-std::string to_display_name(const uint8_t name11[11]) {
-    std::string name(reinterpret_cast<const char*>(name11), 8);
-    std::string ext(reinterpret_cast<const char*>(name11 + 8), 3);
-
+size_t format_display_name(const uint8_t name11[11], char out[13]) {
     // trim right spaces
-    auto rtrim = [](std::string& s) {
-        while (!s.empty() && s.back() == ' ') s.pop_back();
-    };
-    rtrim(name);
-    rtrim(ext);
+    size_t nameLen = 8;
+    while (nameLen > 0 && name11[nameLen - 1] == ' ') --nameLen;
+    size_t extLen = 3;
+    while (extLen > 0 && name11[8 + extLen - 1] == ' ') --extLen;
+
+    size_t n = 0;
+    if (nameLen > 0) {
+        std::memcpy(out, name11, nameLen);
+        n = nameLen;
+        if (extLen > 0) {
+            out[n++] = '.';
+            std::memcpy(out + n, name11 + 8, extLen);
+            n += extLen;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
 
-    if (name.empty()) return std::string();
-    if (!ext.empty()) return name + "." + ext;
-    return name;
+std::string to_display_name(const uint8_t name11[11]) {
+    char buf[13];
+    size_t n = format_display_name(name11, buf);
+    return std::string(buf, n);
 }
 
 std::vector<std::vector<uint8_t>> chunk(const std::vector<uint8_t>& data, size_t chunkSize) {
@@ -0,0 +1,58 @@
+// Verifica que um escritor progride enquanto leitores mantêm a trava ocupada
+// sem intervalo: com a preferência a leitores do std::shared_mutex da glibc
+// o escritor esperaria indefinidamente.
+#include "rw_lock.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+int main() {
+    using namespace std::chrono;
+    constexpr int kReaders = 8;
+    constexpr int kWrites = 200;
+    constexpr auto kLimit = seconds(10);
+
+    fat16::RwLock mu;
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned long> reads{0};
+    long value = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaders; ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::shared_lock<fat16::RwLock> lock(mu);
+                volatile long v = value;
+                (void)v;
+                // segura a trava por um tempo para que os leitores sempre se sobreponham
+                std::this_thread::sleep_for(microseconds(200));
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // espera os leitores saturarem a trava antes de começar a escrever
+    while (reads.load() < kReaders * 4) std::this_thread::yield();
+
+    auto start = steady_clock::now();
+    int done = 0;
+    for (; done < kWrites && steady_clock::now() - start < kLimit; ++done) {
+        std::unique_lock<fat16::RwLock> lock(mu);
+        ++value;
+    }
+    auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    std::printf("%d/%d escritas em %lld ms com %d leitores (%lu leituras)\n",
+                done, kWrites, static_cast<long long>(elapsed), kReaders, reads.load());
+    if (done < kWrites || value != kWrites) {
+        std::fprintf(stderr, "escritor não progrediu com leitores saturando a trava\n");
+        return 1;
+    }
+    return 0;
+}